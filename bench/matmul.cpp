@@ -0,0 +1,29 @@
+// Matrix multiply workload: naive ijk product of two 256 x 256 matrices.
+// Usage: matmul [n]
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char * argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 256;
+  double * a = new double[n * n];
+  double * b = new double[n * n];
+  double * c = new double[n * n];
+  for (int i = 0; i < n * n; ++i){
+    a[i] = i % 7;
+    b[i] = i % 5;
+    c[i] = 0;
+  }
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j){
+      double sum = 0;
+      for (int k = 0; k < n; ++k)
+	sum += a[i * n + k] * b[k * n + j];
+      c[i * n + j] = sum;
+    }
+  printf("%f\n", c[n * n - 1]);
+  delete[] a;
+  delete[] b;
+  delete[] c;
+  return 0;
+}
@@ -0,0 +1,26 @@
+// memcpy-heavy workload: copies a 16 MB buffer back and forth, with a
+// memset between the rounds.
+// Usage: memcopy [rounds]
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define BYTES (16 << 20)
+
+int main(int argc, char * argv[])
+{
+  int rounds = argc > 1 ? atoi(argv[1]) : 4;
+  char * src = new char[BYTES];
+  char * dst = new char[BYTES];
+  for (int i = 0; i < BYTES; ++i)
+    src[i] = (char)(i * 31);
+  for (int r = 0; r < rounds; ++r){
+    memcpy(dst, src, BYTES);
+    memset(src, r, BYTES / 2);
+    memcpy(src, dst, BYTES);
+  }
+  printf("%d\n", src[BYTES - 1] + dst[BYTES / 3]);
+  delete[] src;
+  delete[] dst;
+  return 0;
+}
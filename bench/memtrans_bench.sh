@@ -0,0 +1,83 @@
+#!/bin/bash
+# Runs the memtrans tool configurations over the bundled workloads, records
+# the native and instrumented wall clock time and the slowdown, and checks
+# the LLC statistics against the golden files in bench/golden.
+# Usage: bench/memtrans_bench.sh <pin> <objdir> [check|record]
+#   check:  compare the statistics with the golden ones (default); a run
+#           without a golden file is reported as skipped, not failed
+#   record: rewrite the golden statistics from this run (make bench-record)
+# The heap and stack addresses, hence the set mapping, move a little between
+# runs, so the statistics may differ from the golden ones by
+# MEMTRANS_BENCH_TOLERANCE percent (default 1).
+
+PIN=$1
+OBJDIR=$2
+MODE=${3:-check}
+TOLERANCE=${MEMTRANS_BENCH_TOLERANCE:-1}
+GOLDEN=$(dirname $0)/golden
+REPORT=${OBJDIR}memtrans_bench.txt
+TOOL=${OBJDIR}memtrans_multi.so
+COMMON="-s 4194304 -a 8 -l 64 -ic 0"
+WORKLOADS="stream ptr_chase matmul memcopy mt_stream"
+CONFIGS="multi basic shared"
+KEYS="LLC Load Miss Count|LLC Load Hit Count|LLC Store Miss Count|LLC Store Hit Count|LLC Store Evict Count|Total number of bit transitions"
+
+config_knobs() {
+    case $1 in
+	basic) echo "-stats basic" ;;
+	shared) echo "-shared_llc 1 -llc_locks 1024" ;;
+    esac
+}
+
+workload_args() {
+    case $1 in
+	mt_stream) echo "4 2" ;;
+    esac
+}
+
+now() {
+    date +%s.%N
+}
+
+mkdir -p $GOLDEN
+status=0
+skipped=0
+printf "%-10s %-7s %9s %11s %9s  %s\n" workload config "native s" "pintool s" slowdown golden | tee $REPORT
+for w in $WORKLOADS; do
+    app=${OBJDIR}bench_$w
+    t0=$(now)
+    $app $(workload_args $w) > /dev/null
+    t1=$(now)
+    native=$(awk "BEGIN {print $t1 - $t0}")
+    for c in $CONFIGS; do
+	out=${OBJDIR}memtrans_bench.$w.$c.out
+	stats=${OBJDIR}memtrans_bench.$w.$c.stats
+	golden=$GOLDEN/$w.$c.golden
+	t0=$(now)
+	$PIN -t $TOOL -o $out $COMMON $(config_knobs $c) -- $app $(workload_args $w) > /dev/null
+	t1=$(now)
+	grep -E "^($KEYS): " $out > $stats
+	if [ $MODE = record ]; then
+	    cp $stats $golden
+	    result=recorded
+	elif [ ! -f $golden ]; then
+	    result=skipped
+	    skipped=1
+	elif awk -v tol=$TOLERANCE -F': ' '
+		NR == FNR { golden[$1] = $2; n++; next }
+		{ d = $2 - golden[$1]; if (d < 0) d = -d;
+		  if (!($1 in golden) || d > tol / 100 * golden[$1]) bad = 1; m++ }
+		END { exit bad || n != m }' $golden $stats; then
+	    result=ok
+	else
+	    result=MISMATCH
+	    status=1
+	fi
+	awk -v w=$w -v c=$c -v n=$native -v t="$t1 - $t0" -v r=$result 'BEGIN {
+		split(t, p, " - "); i = p[1] - p[2];
+		printf "%-10s %-7s %9.3f %11.3f %8.1fx  %s\n", w, c, n, i, i / n, r }' | tee -a $REPORT
+    done
+done
+[ $status = 0 ] || echo "Statistics differ from $GOLDEN"
+[ $skipped = 0 ] || echo "No golden statistics for some runs, record them for this Pin kit with make bench-record"
+exit $status
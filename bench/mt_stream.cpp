@@ -0,0 +1,46 @@
+// Multithreaded workload for the shared LLC mode: every thread streams
+// over its own buffer and updates a shared one.
+// Usage: mt_stream <threads> [MB per thread]
+#include <pthread.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static unsigned long mb = 8;
+static volatile unsigned long shared_buf[1 << 16];
+
+static void * worker(void * arg)
+{
+  unsigned long id = (unsigned long)arg;
+  unsigned long n = mb * 1024 * 1024 / sizeof(unsigned long);
+  unsigned long * buf = new unsigned long[n];
+  unsigned long sum = 0;
+  for (int pass = 0; pass < 4; ++pass)
+    for (unsigned long i = 0; i < n; ++i){
+      buf[i] = buf[i] * 3 + i + id;
+      sum += buf[i];
+      if ((i & 63) == 0)
+	shared_buf[(i >> 6) & ((1 << 16) - 1)] += sum;
+    }
+  delete[] buf;
+  return (void*)sum;
+}
+
+int main(int argc, char * argv[])
+{
+  int threads = argc > 1 ? atoi(argv[1]) : 4;
+  if (argc > 2)
+    mb = strtoul(argv[2], NULL, 10);
+  pthread_t * tids = new pthread_t[threads];
+  for (int t = 0; t < threads; ++t)
+    pthread_create(&tids[t], NULL, worker, (void*)(unsigned long)t);
+  unsigned long total = 0;
+  for (int t = 0; t < threads; ++t){
+    void * r;
+    pthread_join(tids[t], &r);
+    total += (unsigned long)r;
+  }
+  printf("%lu\n", total);
+  delete[] tids;
+  return 0;
+}
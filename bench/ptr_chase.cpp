@@ -0,0 +1,39 @@
+// Pointer-chasing workload: a random cycle over 256 K line-sized nodes,
+// built with a fixed seed so every run follows the same chain.
+// Usage: ptr_chase [steps]
+#include <cstdio>
+#include <cstdlib>
+
+#define NODES (1 << 18)
+
+struct NODE
+{
+  NODE * next;
+  unsigned long pad[7];
+};
+
+int main(int argc, char * argv[])
+{
+  unsigned long steps = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  NODE * nodes = new NODE[NODES];
+  unsigned * order = new unsigned[NODES];
+  for (unsigned i = 0; i < NODES; ++i)
+    order[i] = i;
+  unsigned long seed = 12345;
+  for (unsigned i = NODES - 1; i > 0; --i){
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    unsigned j = (seed >> 33) % (i + 1);
+    unsigned t = order[i];
+    order[i] = order[j];
+    order[j] = t;
+  }
+  for (unsigned i = 0; i < NODES; ++i)
+    nodes[order[i]].next = &nodes[order[(i + 1) % NODES]];
+  NODE * p = &nodes[order[0]];
+  for (unsigned long s = 0; s < steps; ++s)
+    p = p->next;
+  printf("%ld\n", (long)(p - nodes));
+  delete[] order;
+  delete[] nodes;
+  return 0;
+}
@@ -0,0 +1,25 @@
+// Streaming workload: STREAM triad over three 8 MB arrays.
+// Usage: stream [iterations]
+#include <cstdio>
+#include <cstdlib>
+
+#define N (1 << 20)
+
+static double a[N], b[N], c[N];
+
+int main(int argc, char * argv[])
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 4;
+  for (int i = 0; i < N; ++i){
+    b[i] = i;
+    c[i] = 2.0 * i;
+  }
+  for (int it = 0; it < iterations; ++it)
+    for (int i = 0; i < N; ++i)
+      a[i] = b[i] + 3.0 * c[i];
+  double sum = 0;
+  for (int i = 0; i < N; i += 1024)
+    sum += a[i];
+  printf("%f\n", sum);
+  return 0;
+}
@@ -31,12 +31,21 @@
 /*! @file
  *  This file contains an ISA-portable PIN tool for functional simulation of
  *  instruction+data TLB+cache hierarchies
+ *
+ *  The engine (-engine), statistics level (-stats), output format (-format)
+ *  and sampling (-sample_on, -sample_period) are chosen by knobs when the
+ *  tool starts, by picking pre-instantiated analysis routines, so the
+ *  analysis path has no branches for them. Built with -DMEMTRANS_PINPLAY
+ *  (memtrans_multi_pinplay.so) the tool also logs and replays pinballs.
  */
 
 #include <iostream>
 #include <fstream>
 #include <cstdint>
 #include "pin.H"
+#ifdef MEMTRANS_PINPLAY
+#include "pinplay.H"
+#endif
 #include "instlib.H"
 #include <time.h>
 
@@ -45,6 +54,24 @@
 typedef UINT32 CACHE_STATS; // type of cache hit/miss counters
 
 #include "memtrans_cache_multi.H"
+#include "memtrans_roi.H"
+#include "memtrans_filter.H"
+#include "memtrans_alloc.H"
+#include "memtrans_heatmap.H"
+#include "memtrans_checkpoint.H"
+#include "memtrans_sweep.H"
+#include "memtrans_dram.H"
+#include "memtrans_telemetry.H"
+#include "memtrans_converge.H"
+
+#ifdef MEMTRANS_PINPLAY
+// should be linked with libpinplay.a, libzlib.a, libbz2.a
+PINPLAY_ENGINE pinplay_engine;
+
+#define KNOB_LOG_NAME "log"
+#define KNOB_REPLAY_NAME "replay"
+#define KNOB_FAMILY "pintool:pinplay-driver"
+#endif
 
 //================================================================================
 // Knobs
@@ -52,7 +79,7 @@ typedef UINT32 CACHE_STATS; // type of cache hit/miss counters
 ofstream out;
 KNOB<string> knob_output(KNOB_MODE_WRITEONCE, "pintool",
 			 "o", "memtrans.out", "specify log file name");
-KNOB<UINT32> knob_size(KNOB_MODE_WRITEONCE, "pintool",
+KNOB<UINT64> knob_size(KNOB_MODE_WRITEONCE, "pintool",
 		       "s", "8388608", "Cache size (bytes)");
 KNOB<UINT32> knob_associativity(KNOB_MODE_WRITEONCE, "pintool", 
 				"a", "8", "Cache associativity");
@@ -60,112 +87,815 @@ KNOB<UINT32> knob_line_size(KNOB_MODE_WRITEONCE, "pintool",
 			    "l", "64", "Cache line size");
 KNOB<UINT32> knob_sim_inst(KNOB_MODE_WRITEONCE, "pintool",
 			   "ic", "1", "Instruction cache simulation (default: off)");
+KNOB<BOOL> knob_ic_bbl(KNOB_MODE_WRITEONCE, "pintool",
+			 "ic_bbl", "1", "Simulate the instruction fetches with one call per basic block line instead of per instruction");
+KNOB<BOOL> knob_shared_llc(KNOB_MODE_WRITEONCE, "pintool",
+			   "shared_llc", "0", "Thread-safe shared LLC for multithreaded applications");
+KNOB<UINT32> knob_llc_locks(KNOB_MODE_WRITEONCE, "pintool",
+			    "llc_locks", "1024", "Number of set lock stripes in the shared LLC mode (power of 2)");
+KNOB<string> knob_roi_rtn(KNOB_MODE_WRITEONCE, "pintool",
+			  "roi_rtn", "", "Simulate only while this routine is executing");
+KNOB<ADDRINT> knob_roi_start_pc(KNOB_MODE_WRITEONCE, "pintool",
+				"roi_start_pc", "0", "Start simulating when this PC is reached (0: unused)");
+KNOB<ADDRINT> knob_roi_stop_pc(KNOB_MODE_WRITEONCE, "pintool",
+			       "roi_stop_pc", "0", "Stop simulating when this PC is reached (0: unused)");
+KNOB<UINT64> knob_roi_start_icount(KNOB_MODE_WRITEONCE, "pintool",
+				   "roi_start_icount", "0", "Start simulating after this many instructions (0: unused)");
+KNOB<UINT64> knob_roi_stop_icount(KNOB_MODE_WRITEONCE, "pintool",
+				  "roi_stop_icount", "0", "Stop simulating after this many instructions (0: unused)");
+KNOB<string> knob_roi_marker(KNOB_MODE_WRITEONCE, "pintool",
+			     "roi_marker", "none", "ROI marker instructions: none, xchg (xchg bx,bx toggles the ROI) or ssc (SSC marks)");
+KNOB<UINT32> knob_roi_ssc_start(KNOB_MODE_WRITEONCE, "pintool",
+				"roi_ssc_start", "0x111", "SSC mark that starts the ROI");
+KNOB<UINT32> knob_roi_ssc_stop(KNOB_MODE_WRITEONCE, "pintool",
+			       "roi_ssc_stop", "0x222", "SSC mark that stops the ROI");
+KNOB<string> knob_filter_img_include(KNOB_MODE_APPEND, "pintool",
+				     "filter_img_include", "", "Only simulate code of this image (file name, full path or main), can be repeated");
+KNOB<string> knob_filter_img_exclude(KNOB_MODE_APPEND, "pintool",
+				     "filter_img_exclude", "", "Do not simulate code of this image, can be repeated");
+KNOB<string> knob_filter_rtn_include(KNOB_MODE_APPEND, "pintool",
+				     "filter_rtn_include", "", "Only simulate routines matching this regex, can be repeated");
+KNOB<string> knob_filter_rtn_exclude(KNOB_MODE_APPEND, "pintool",
+				     "filter_rtn_exclude", "", "Do not simulate routines matching this regex, can be repeated");
+KNOB<string> knob_filter_range_include(KNOB_MODE_APPEND, "pintool",
+				       "filter_range_include", "", "Only simulate code in this address range (low:high), can be repeated");
+KNOB<string> knob_filter_range_exclude(KNOB_MODE_APPEND, "pintool",
+				       "filter_range_exclude", "", "Do not simulate code in this address range (low:high), can be repeated");
+KNOB<BOOL> knob_filter_warm(KNOB_MODE_WRITEONCE, "pintool",
+			    "filter_warm", "0", "Filtered accesses still warm the cache (tag-only, no statistics)");
+KNOB<BOOL> knob_thread_stats(KNOB_MODE_WRITEONCE, "pintool",
+			     "thread_stats", "0", "Print a per-thread breakdown of the statistics");
+KNOB<UINT32> knob_sector_size(KNOB_MODE_WRITEONCE, "pintool",
+			      "sector", "0", "Sector size (bytes) for the sectored LLC analysis (0: off)");
+KNOB<UINT32> knob_alloc_sites(KNOB_MODE_WRITEONCE, "pintool",
+			      "alloc_sites", "0", "Attribute LLC fills and writebacks to heap allocation sites and print the top N (0: off)");
+KNOB<UINT32> knob_heatmap(KNOB_MODE_WRITEONCE, "pintool",
+			  "heatmap", "0", "Count LLC fills and writebacks per page and print the top K pages (0: off)");
+KNOB<UINT32> knob_heatmap_page(KNOB_MODE_WRITEONCE, "pintool",
+			       "heatmap_page", "4096", "Page size of the heatmap");
+KNOB<string> knob_heatmap_file(KNOB_MODE_WRITEONCE, "pintool",
+			       "heatmap_file", "", "Binary dump of the per-page heatmap, sorted by page");
+KNOB<UINT32> knob_pf_next_lines(KNOB_MODE_WRITEONCE, "pintool",
+				"pf_next_lines", "0", "Next-line prefetcher: lines prefetched after a miss (0: off)");
+KNOB<UINT32> knob_pf_stride_entries(KNOB_MODE_WRITEONCE, "pintool",
+				    "pf_stride_entries", "0", "Stride prefetcher: entries of the per-PC table, power of 2 (0: off)");
+KNOB<UINT32> knob_pf_stride_degree(KNOB_MODE_WRITEONCE, "pintool",
+				   "pf_stride_degree", "2", "Stride prefetcher: strides prefetched ahead");
+KNOB<UINT32> knob_pf_streams(KNOB_MODE_WRITEONCE, "pintool",
+			     "pf_streams", "0", "Stream prefetcher: number of tracked streams (0: off)");
+KNOB<UINT32> knob_pf_stream_depth(KNOB_MODE_WRITEONCE, "pintool",
+				  "pf_stream_depth", "4", "Stream prefetcher: lines prefetched ahead of a stream");
+KNOB<BOOL> knob_compress(KNOB_MODE_WRITEONCE, "pintool",
+			 "compress", "0", "Analyse the compressibility (zero/repeated, BDI, FPC) of the transferred lines");
+KNOB<UINT32> knob_memo_entries(KNOB_MODE_WRITEONCE, "pintool",
+			       "memo_entries", "4096", "Entries of the per-thread transition memo table, power of 2 (0: off)");
+KNOB<string> knob_sketch(KNOB_MODE_WRITEONCE, "pintool",
+			 "sketch", "", "Word widths of the transferred-word sketches, comma separated of 16, 32, 64 (empty: off)");
+KNOB<double> knob_sketch_eps(KNOB_MODE_WRITEONCE, "pintool",
+			     "sketch_eps", "0.001", "Count-min sketch error, as a fraction of the counted words");
+KNOB<double> knob_sketch_delta(KNOB_MODE_WRITEONCE, "pintool",
+			       "sketch_delta", "0.01", "Count-min sketch probability of exceeding -sketch_eps");
+KNOB<UINT32> knob_sketch_topk(KNOB_MODE_WRITEONCE, "pintool",
+			      "sketch_topk", "32", "Entries of the top-K word and word transition lists");
+KNOB<double> knob_sketch_hll_error(KNOB_MODE_WRITEONCE, "pintool",
+				   "sketch_hll_error", "0.01", "Relative standard error of the distinct word counts");
+KNOB<double> knob_converge_error(KNOB_MODE_WRITEONCE, "pintool",
+				 "converge_error", "0", "Detach once the metrics are within this relative error (0: off, 0.01: 1%)");
+KNOB<UINT64> knob_converge_window(KNOB_MODE_WRITEONCE, "pintool",
+				  "converge_window", "10000000", "Instructions per convergence window");
+KNOB<UINT32> knob_converge_min_windows(KNOB_MODE_WRITEONCE, "pintool",
+				       "converge_min_windows", "10", "Windows before the convergence can be decided");
+KNOB<double> knob_converge_z(KNOB_MODE_WRITEONCE, "pintool",
+			     "converge_z", "1.96", "Normal quantile of the confidence intervals (1.96: 95%)");
+KNOB<string> knob_converge_metrics(KNOB_MODE_WRITEONCE, "pintool",
+				   "converge_metrics", "miss,entropy", "Metrics that must converge, comma separated of miss, entropy");
+KNOB<BOOL> knob_footprint(KNOB_MODE_WRITEONCE, "pintool",
+			   "footprint", "0", "Estimate the unique line and page footprint");
+KNOB<UINT32> knob_footprint_page(KNOB_MODE_WRITEONCE, "pintool",
+				 "footprint_page", "4096", "Page size of the page footprint in B");
+KNOB<UINT64> knob_footprint_window(KNOB_MODE_WRITEONCE, "pintool",
+				   "footprint_window", "1000000", "Line accesses per window of the footprint curve (0: no curve)");
+KNOB<double> knob_footprint_hll_error(KNOB_MODE_WRITEONCE, "pintool",
+				      "footprint_hll_error", "0.01", "Relative standard error of the footprint estimates");
+KNOB<string> knob_set_hash(KNOB_MODE_WRITEONCE, "pintool",
+			   "set_hash", "modulo", "LLC set index function: modulo, xor (XOR-folded tag), prime (prime displacement) or slice (-llc_slice_masks)");
+KNOB<string> knob_llc_slice_masks(KNOB_MODE_WRITEONCE, "pintool",
+				  "llc_slice_masks", "", "Slice hash matrix of -set_hash slice: comma separated hexadecimal address masks, one per slice bit");
+KNOB<BOOL> knob_set_profile(KNOB_MODE_WRITEONCE, "pintool",
+			    "set_profile", "0", "Count the lookups and misses of every LLC set and print their histogram");
+KNOB<UINT32> knob_set_profile_top(KNOB_MODE_WRITEONCE, "pintool",
+				  "set_profile_top", "16", "Sets with the most misses printed by -set_profile");
+KNOB<UINT32> knob_shadow_mb(KNOB_MODE_WRITEONCE, "pintool",
+			    "shadow_mb", "0", "Memory budget in MB of the shadow store of the LLC line data (0: off, evictions read the memory)");
+KNOB<string> knob_ckpt_save(KNOB_MODE_WRITEONCE, "pintool",
+			    "ckpt_save", "", "Save the cache state and statistics to this checkpoint file");
+KNOB<BOOL> knob_ckpt_at_roi_exit(KNOB_MODE_WRITEONCE, "pintool",
+				 "ckpt_at_roi_exit", "0", "Save the checkpoint when the ROI is first left instead of at Fini");
+KNOB<string> knob_ckpt_restore(KNOB_MODE_WRITEONCE, "pintool",
+			       "ckpt_restore", "", "Start from the cache state of this checkpoint file");
+KNOB<BOOL> knob_ckpt_restore_stats(KNOB_MODE_WRITEONCE, "pintool",
+				   "ckpt_restore_stats", "0", "Also restore the statistics of the checkpoint");
+KNOB<string> knob_sweep(KNOB_MODE_APPEND, "pintool",
+			"sweep", "", "Simulate this LLC configuration (size:associativity:line[:lru|fifo|random]) in its own thread instead of the main LLC, can be repeated");
+KNOB<UINT32> knob_sweep_buffer(KNOB_MODE_WRITEONCE, "pintool",
+			       "sweep_buffer", "16384", "Accesses buffered per thread before they are handed to the -sweep configurations");
+KNOB<UINT64> knob_pf_latency(KNOB_MODE_WRITEONCE, "pintool",
+			     "pf_latency", "16", "A prefetched line used within this many LLC accesses counts as late");
+KNOB<string> knob_engine(KNOB_MODE_WRITEONCE, "pintool",
+			 "engine", "set", "Cache engine: set (set-associative, -a ways) or direct (direct-mapped)");
+KNOB<string> knob_stats(KNOB_MODE_WRITEONCE, "pintool",
+			"stats", "full", "Statistics level: full (value and transition histograms) or basic (counts, transitions and entropy)");
+KNOB<string> knob_format(KNOB_MODE_WRITEONCE, "pintool",
+			 "format", "multi", "Output format: multi or legacy (the format of the original direct-mapped memtrans tool)");
+KNOB<UINT64> knob_sample_on(KNOB_MODE_WRITEONCE, "pintool",
+			    "sample_on", "10", "Sampling: accesses simulated at the start of every sampling period");
+KNOB<UINT64> knob_sample_period(KNOB_MODE_WRITEONCE, "pintool",
+				"sample_period", "0", "Sampling: accesses per sampling period of a thread (0: off, every access is simulated)");
+KNOB<BOOL> knob_dram(KNOB_MODE_WRITEONCE, "pintool",
+		    "dram", "0", "Model the DRAM behind the LLC (channels, banks, row buffers, FR-FCFS queues)");
+KNOB<UINT32> knob_dram_channels(KNOB_MODE_WRITEONCE, "pintool",
+				"dram_channels", "2", "DRAM channels");
+KNOB<UINT32> knob_dram_ranks(KNOB_MODE_WRITEONCE, "pintool",
+			     "dram_ranks", "1", "DRAM ranks per channel");
+KNOB<UINT32> knob_dram_banks(KNOB_MODE_WRITEONCE, "pintool",
+			     "dram_banks", "8", "DRAM banks per rank");
+KNOB<UINT32> knob_dram_row(KNOB_MODE_WRITEONCE, "pintool",
+			   "dram_row", "8192", "DRAM row buffer size (bytes)");
+KNOB<string> knob_dram_map(KNOB_MODE_WRITEONCE, "pintool",
+			   "dram_map", "row:rank:bank:column:channel", "DRAM address fields from the most significant bits, row first");
+KNOB<BOOL> knob_dram_xor(KNOB_MODE_WRITEONCE, "pintool",
+			 "dram_xor", "0", "XOR the DRAM bank and channel bits with the low row bits");
+KNOB<string> knob_dram_page(KNOB_MODE_WRITEONCE, "pintool",
+			    "dram_page", "open", "DRAM page policy: open or closed");
+KNOB<UINT32> knob_dram_queue(KNOB_MODE_WRITEONCE, "pintool",
+			     "dram_queue", "32", "DRAM request queue entries per channel");
+KNOB<string> knob_dram_timing(KNOB_MODE_WRITEONCE, "pintool",
+			      "dram_timing", "14:14:14", "DRAM timing tCL:tRCD:tRP (DRAM cycles)");
+KNOB<UINT64> knob_dram_interval(KNOB_MODE_WRITEONCE, "pintool",
+				"dram_interval", "1", "DRAM cycles per LLC access, for the arrival times of the requests");
+KNOB<string> knob_telemetry(KNOB_MODE_WRITEONCE, "pintool",
+			    "telemetry", "", "Publish live statistics in this POSIX shared-memory region, e.g. /memtrans (read with memtrans_stat)");
+KNOB<UINT32> knob_telemetry_ms(KNOB_MODE_WRITEONCE, "pintool",
+			       "telemetry_ms", "1000", "Milliseconds between two telemetry updates");
+KNOB<BOOL> knob_telemetry_hist(KNOB_MODE_WRITEONCE, "pintool",
+			       "telemetry_hist", "0", "Also publish the byte value and transfer-wise transition histograms");
+
+#ifdef MEMTRANS_PINPLAY
+KNOB_COMMENT pinplay_driver_knob_family(KNOB_FAMILY, "PinPlay Driver Knobs");
+
+KNOB<BOOL> knob_replayer(KNOB_MODE_WRITEONCE, KNOB_FAMILY,
+			 KNOB_REPLAY_NAME, "0", "Replay a pinball");
+KNOB<BOOL> knob_logger(KNOB_MODE_WRITEONCE, KNOB_FAMILY,
+		       KNOB_LOG_NAME, "0", "Create a pinball");
+#endif
 
 namespace LLC
 {
-  UINT32 cacheSize;
+  UINT64 cacheSize;
   UINT32 lineSize;
   ADDRINT notLineMask;
-  UINT32 max_sets;
+  UINT64 max_sets;
   UINT32 associativity;
 }
 
 clock_t start;
+bool checkpointSaved = false;
+bool fullStats = true;
+bool legacyFormat = false;
+UINT64 sampleOn;
+UINT64 samplePeriod = 0;
+bool bblFetch = false;
+bool repRange = false; // REP MOVS/STOS are simulated as whole ranges
+UINT64 convergeStep; // instructions of a thread between two convergence checks
+
+LOCALFUN VOID SaveCheckpoint(const MEMTRANS_STATS &st)
+{
+  if (!saveCheckpoint(knob_ckpt_save.Value(), st))
+    std::cerr << "Error, could not write the checkpoint " << knob_ckpt_save.Value() << "!\n";
+  checkpointSaved = true;
+}
+
+// ROI exit hook of -ckpt_at_roi_exit, the first exit saves the checkpoint
+LOCALFUN VOID CheckpointAtRoiExit(void)
+{
+  if (checkpointSaved)
+    return;
+  MEMTRANS_STATS * snapshot = (MEMTRANS_STATS*)ReserveLazyRegion(sizeof(MEMTRANS_STATS));
+  if (!snapshot)
+    return;
+  snapshotStats(*snapshot);
+  SaveCheckpoint(*snapshot);
+  munmap(snapshot, sizeof(MEMTRANS_STATS));
+}
+
+// -format legacy: the output of the original direct-mapped memtrans tool,
+// where same_bytes is the diagonal of the bus-wise transition counts
+LOCALFUN VOID PrintLegacyStats(const MEMTRANS_STATS &st, double bitEntropy, double elapsed_time)
+{
+  out << "Elapsed time: " << elapsed_time << "\n";
+  out << "LLC miss count: " << st.LLCMissCount[LOAD_ACCESS] + st.LLCMissCount[STORE_ACCESS] << "\n";
+  out << "LLC store evict count: " << st.LLCEvictCount << "\n";
+  out << "Total number of bit transitions: " << st.totalTransitions << "\n";
+  out << "Bit entropy: " << bitEntropy << "\n\n";
+
+  out << "Other metrics" << "\n";
+
+  // DO NOT MODIFY BELOW CODE OUTPUT STRUCTURE
+  out << "Number of bytes with value:" << "\n";
+  UINT64 totalBytes = 0;
+  for (int i = 0; i < 256; ++i) {
+    totalBytes += st.counts[i];
+    out << i << ": " << st.counts[i] << "\n";
+  }
+
+  out << "Number of times every byte is repeated:" << std::endl;
+  for (int i = 0; i < 256; ++i)
+    out << i << ": " << st.transition_counts_bw[i][i] << std::endl;
+
+  for (int i = 0; i < 256; ++i)
+    for (int j = 0; j < 256; ++j)
+      out << i << "," << j << ": " << st.transition_counts_tw[i][j] << "\n";
+
+  // DO NOT MODIFY ABOVE CODE OUTPUTSTRUCTURE
+
+  out << "Total number of bytes transferred: " << totalBytes << "\n\n";
+  out << "Elapsed time: " << elapsed_time << "\n";
+}
+
 LOCALFUN VOID Fini(int code, VOID * v)
 {
   clock_t end = clock() ;
   double elapsed_time = (end-start)/(double)CLOCKS_PER_SEC ;
-  double bitEntropy = calcBitEntropy(LLC::lineSize, 8);
+  mergeAllStats();
+  finishTelemetry(totalStats);
+  if (knob_sweep.NumberOfValues()){
+    out << "Elapsed time: " << elapsed_time << "\n\n";
+    printSweep(out);
+    out.close();
+    cleanupSweep();
+    cleanupCache();
+    return;
+  }
+  if (!knob_ckpt_save.Value().empty() && !checkpointSaved)
+    SaveCheckpoint(totalStats);
+  const MEMTRANS_STATS &st = totalStats;
+  double bitEntropy = calcBitEntropy(st, LLC::lineSize, 8);
+
+  if (legacyFormat){
+    PrintLegacyStats(st, bitEntropy, elapsed_time);
+    out.close();
+    cleanupFilter();
+    cleanupHeatmap();
+    cleanupFootprint();
+    cleanupSketches();
+    cleanupShadow();
+    cleanupCache();
+    return;
+  }
 
   out << "Elapsed time: " << elapsed_time << "\n\n";
 
   out << "Cache size: " << LLC::cacheSize * LLC::associativity << " B\n";
   out << "Associativity: " << LLC::associativity << (LLC::associativity == 1 ? " way\n" : " ways\n");
   out << "Line size: " << LLC::lineSize << " B\n";
+  if (SETS::hash != SET_HASH_MODULO)
+    out << "Set index: " << setHashNames[SETS::hash] << "\n";
   out << "DRAM bus width: 8 B\n"; 
-  out << "Instructions cache simulation: " << (knob_sim_inst.Value() == 0 ? "off\n\n" : "on\n\n");
-
-  out << "LLC Load Miss Count: " << LLCMissCount[LOAD_ACCESS] << "\n";
-  out << "LLC Load Hit Count: " << LLCHitCount[LOAD_ACCESS] << "\n";
-  double loadAccesses =  (double)LLCHitCount[LOAD_ACCESS] + (double)LLCMissCount[LOAD_ACCESS];
-  out << "LLC Load Miss Ratio: " << ((double)LLCMissCount[LOAD_ACCESS] / loadAccesses)*100 << "%\n\n";
-  out << "LLC Store Miss Count: " << LLCMissCount[STORE_ACCESS] << "\n";
-  out << "LLC Store Hit Count: " << LLCHitCount[STORE_ACCESS] << "\n";
-  double storeAccesses =  (double)LLCHitCount[STORE_ACCESS] + (double)LLCMissCount[STORE_ACCESS];
-  out << "LLC Store Evict Count: " << LLCEvictCount << "\n";
-  out << "LLC Store Miss Ratio: " << ((double)LLCMissCount[STORE_ACCESS]) / storeAccesses*100 << "%\n\n";
-  double totalMissCount = (double)(LLCMissCount[STORE_ACCESS] + LLCMissCount[LOAD_ACCESS]);
-  double totalHitCount = (double)(LLCHitCount[STORE_ACCESS] + LLCHitCount[LOAD_ACCESS]);
+  out << "Instructions cache simulation: " << (knob_sim_inst.Value() == 0 ? "off\n" : "on\n");
+  // the batched paths count some accesses as hits without simulating
+  // them, see FetchRuns and CacheRep
+  if (bblFetch || repRange)
+    out << "Batched accesses: " << (bblFetch ? "fetches per basic block line" : "")
+	<< (bblFetch && repRange ? ", " : "") << (repRange ? "whole REP MOVS/STOS ranges" : "") << "\n";
+  out << "ROI entries: " << ROI::entries << "\n";
+  if (!knob_telemetry.Value().empty() || CONVERGE::enabled)
+    out << "Instructions: " << totalStats.instructions << "\n";
+  if (samplePeriod)
+    out << "Sampling: " << sampleOn << " of every " << samplePeriod << " accesses ("
+	<< ((double)sampleOn / (double)samplePeriod)*100 << "% simulated, counts not scaled)\n";
+  if (CONVERGE::enabled)
+    printConverge(out);
+  out << "Statistics level: " << (fullStats ? "full\n\n" : "basic\n\n");
+
+  out << "LLC Load Miss Count: " << st.LLCMissCount[LOAD_ACCESS] << "\n";
+  out << "LLC Load Hit Count: " << st.LLCHitCount[LOAD_ACCESS] << "\n";
+  double loadAccesses =  (double)st.LLCHitCount[LOAD_ACCESS] + (double)st.LLCMissCount[LOAD_ACCESS];
+  out << "LLC Load Miss Ratio: " << ((double)st.LLCMissCount[LOAD_ACCESS] / loadAccesses)*100 << "%\n\n";
+  out << "LLC Store Miss Count: " << st.LLCMissCount[STORE_ACCESS] << "\n";
+  out << "LLC Store Hit Count: " << st.LLCHitCount[STORE_ACCESS] << "\n";
+  double storeAccesses =  (double)st.LLCHitCount[STORE_ACCESS] + (double)st.LLCMissCount[STORE_ACCESS];
+  out << "LLC Store Evict Count: " << st.LLCEvictCount << "\n";
+  out << "LLC Store Miss Ratio: " << ((double)st.LLCMissCount[STORE_ACCESS]) / storeAccesses*100 << "%\n\n";
+  double totalMissCount = (double)(st.LLCMissCount[STORE_ACCESS] + st.LLCMissCount[LOAD_ACCESS]);
+  double totalHitCount = (double)(st.LLCHitCount[STORE_ACCESS] + st.LLCHitCount[LOAD_ACCESS]);
   double totalAccesses = totalMissCount + totalHitCount;
   out << "LLC Total Miss Count: " << totalMissCount << "\n";
   out << "LLC Total Hit Count: " << totalHitCount << "\n";
   out << "LLC Total Miss Ratio: " << (totalMissCount / totalAccesses)*100 << "%\n\n";
+  if (FOOTPRINT_EST::enabled){
+    printFootprint(out, LLC::lineSize);
+    out << "\n";
+  }
+  if (_setPressure){
+    printSetProfile(out);
+    out << "\n";
+  }
+  if (st.multiElements || st.multiMasked)
+    out << "Gather/scatter elements: " << st.multiElements << " (" << st.multiMasked << " masked off), "
+	<< st.multiAccesses << " line accesses\n\n";
+  if (st.warmWritebacks)
+    out << "Dirty lines evicted by filtered (warming) accesses, writebacks not counted above: "
+	<< st.warmWritebacks << "\n\n";
 
-  out << "Total number of bit transitions: " << totalTransitions << "\n";
+  out << "Total number of bit transitions: " << st.totalTransitions << "\n";
   out << "Bit entropy: " << bitEntropy << "\n";
+  if (_memoEntries)
+    out << "Transferred lines from the memo table: " << st.memoHits << " repeated, " << st.memoUniform << " uniform\n";
 
   double reuse_ratios[256];
   double total_reuse_ratio = 0.0;
   for (int i = 0; i < 256; ++i)
-    reuse_ratios[i] = ((double)reuse_counts[i])/((double)evicted_counts[i]);
+    reuse_ratios[i] = ((double)st.reuse_counts[i])/((double)st.evicted_counts[i]);
   for (int i = 0; i < 256; ++i){
     total_reuse_ratio += reuse_ratios[i];
   }
   total_reuse_ratio/=256;
   out << "Cache line utilization ratio: " << total_reuse_ratio << "\n\n";
+
+  if (_sectorSize){
+    out << "Sectored LLC (" << _sectorSize << " B sectors, evicted lines only)\n";
+    out << "Evicted lines: " << st.sectorEvictCount << "\n";
+    out << "Full-line fill bytes: " << st.sectorFullFillBytes << "\n";
+    out << "Sectored fill bytes: " << st.sectorFillBytes << "\n";
+    out << "Fill traffic saved: " << (1.0 - (double)st.sectorFillBytes / (double)st.sectorFullFillBytes)*100 << "%\n";
+    out << "Full-line fill bit transitions: " << st.sectorFullFillTransitions << "\n";
+    out << "Sectored fill bit transitions: " << st.sectorFillTransitions << "\n";
+    out << "Fill transitions saved: " << (1.0 - (double)st.sectorFillTransitions / (double)st.sectorFullFillTransitions)*100 << "%\n";
+    out << "Dirty evicted lines: " << st.sectorWritebackCount << "\n";
+    out << "Full-line writeback bytes: " << st.sectorFullWritebackBytes << "\n";
+    out << "Sectored writeback bytes: " << st.sectorWritebackBytes << "\n";
+    out << "Writeback traffic saved: " << (1.0 - (double)st.sectorWritebackBytes / (double)st.sectorFullWritebackBytes)*100 << "%\n";
+    out << "Full-line writeback bit transitions: " << st.sectorFullWritebackTransitions << "\n";
+    out << "Sectored writeback bit transitions: " << st.sectorWritebackTransitions << "\n";
+    out << "Writeback transitions saved: " << (1.0 - (double)st.sectorWritebackTransitions / (double)st.sectorFullWritebackTransitions)*100 << "%\n\n";
+  }
+
+  if (_compression){
+    static const char * names[COMPRESSORS] = {"zero/repeated", "BDI", "FPC"};
+    UINT64 lineBytes = st.compressedLines * _lineSize;
+    out << "Link compression of " << st.compressedLines << " transferred lines ("
+	<< lineBytes << " B, " << st.uncompressedTransitions << " bit transitions)\n";
+    out << "scheme: compressed bytes, bandwidth reduction, bandwidth reduction in 8 B beats, bit transitions\n";
+    for (UINT32 c = 0; c < COMPRESSORS; ++c)
+      out << names[c] << ": " << st.compressedBytes[c] << ", "
+	  << (1.0 - (double)st.compressedBytes[c] / (double)lineBytes)*100 << "%, "
+	  << (1.0 - (double)(st.compressedBeats[c] * 8) / (double)lineBytes)*100 << "%, "
+	  << st.compressedTransitions[c] << "\n";
+    out << "Compressed size histogram (size: zero/repeated, BDI, FPC):\n";
+    for (UINT32 size = 1; size <= _lineSize; ++size)
+      if (st.compressedSizes[COMP_ZERO_REP][size] || st.compressedSizes[COMP_BDI][size] || st.compressedSizes[COMP_FPC][size])
+	out << size << ": " << st.compressedSizes[COMP_ZERO_REP][size] << ", "
+	    << st.compressedSizes[COMP_BDI][size] << ", " << st.compressedSizes[COMP_FPC][size] << "\n";
+    out << "\n";
+  }
+
+  if (_prefetching){
+    static const char * names[PF_SOURCES] = {"", "next-line", "stride", "stream"};
+    out << "Prefetches (prefetcher: issued, filled, useful, late, useless, fill transitions, writebacks, writeback transitions), not included above\n";
+    for (UINT32 p = PF_NEXT_LINE; p < PF_SOURCES; ++p)
+      out << names[p] << ": " << st.prefetchIssued[p] << ", " << st.prefetchFills[p] << ", "
+	  << st.prefetchUseful[p] << ", " << st.prefetchLate[p] << ", " << st.prefetchUseless[p] << ", "
+	  << st.prefetchFillTransitions[p] << ", " << st.prefetchWritebacks[p] << ", "
+	  << st.prefetchWritebackTransitions[p] << "\n";
+    out << "\n";
+  }
   
+  // the histograms are only collected at the full statistics level
+  if (fullStats){
   out << "Other metrics" << "\n";
 
   // DO NOT MODIFY BELOW CODE OUTPUT STRUCTURE
   out << "Sequential 0 counts, bus-wise:\n";
   for (int i = 0; i < 7; ++i)
-    out << i + 2 << ": " << consecutive_zero_counts_bw[i] << "\n";
+    out << i + 2 << ": " << st.consecutive_zero_counts_bw[i] << "\n";
   
   out << "\nSequential 0 counts, transfer-wise:\n";
-  for (int i = 0; i < 7; ++i)
-    out << i + 2 << ": " << consecutive_zero_counts_tw[i] << "\n";
+  for (UINT32 i = 0; i < LLC::lineSize / 8 - 1; ++i)
+    out << i + 2 << ": " << st.consecutive_zero_counts_tw[i] << "\n";
   
   out << "\nNumber of bytes with value:\n";
   for (int i = 0; i < 256; ++i) {
-    out << i << ": " << counts[i] << "\n";
+    out << i << ": " << st.counts[i] << "\n";
   }
 
   out << "\nTransition counts, bus-wise:\n";
   for (int i = 0; i < 256; ++i)
     for (int j = 0; j < 256; ++j)
-      out << i << "," << j << ": " << transition_counts_bw[i][j] << "\n";
+      out << i << "," << j << ": " << st.transition_counts_bw[i][j] << "\n";
 
   out << "Transition counts, transfer-wise:\n";
   for (int i = 0; i < 256; ++i)
     for (int j = 0; j < 256; ++j)
-      out << i << "," << j << ": " << transition_counts_tw[i][j] << "\n";
+      out << i << "," << j << ": " << st.transition_counts_tw[i][j] << "\n";
 
   // DO NOT MODIFY ABOVE CODE OUTPUTSTRUCTURE
+  }
 
   // the values inside the array are set even if the value is used only one time
   // after being brought in
   out << "\nReuse counts for values brought in to the cache:\n";
   for (int i = 0; i < 256; ++i) {
-    out << i << ": " << reuse_counts[i] << "\n";
+    out << i << ": " << st.reuse_counts[i] << "\n";
   }
   out << "\nReuse ratios for values brought in to the cache:\n";
   for (int i = 0; i < 256; ++i)
     out << i << ": " << reuse_ratios[i] << "\n";
+  if (SKETCH::enabled)
+    printSketches(out);
+  
   
+  if (knob_thread_stats.Value()){
+    out << "\nPer-thread statistics (tid: load misses, load hits, store misses, store hits, evictions, bit transitions):\n";
+    for (UINT32 i = 0; i < threadSummaries.size(); ++i){
+      const THREAD_SUMMARY &t = threadSummaries[i];
+      out << t.tid << ": " << t.LLCMissCount[LOAD_ACCESS] << ", " << t.LLCHitCount[LOAD_ACCESS] << ", "
+	  << t.LLCMissCount[STORE_ACCESS] << ", " << t.LLCHitCount[STORE_ACCESS] << ", "
+	  << t.LLCEvictCount << ", " << t.totalTransitions << "\n";
+    }
+  }
   
+  if (knob_alloc_sites.Value())
+    printAllocSites(out, knob_alloc_sites.Value());
+  if (knob_heatmap.Value() || !knob_heatmap_file.Value().empty())
+    printHeatmap(out, knob_heatmap_file.Value(), knob_heatmap.Value());
+  if (DRAM::enabled)
+    printDram(out);
+
   out.close();
-  delete[] lineBytes;
+  cleanupFilter();
+  cleanupHeatmap();
+  cleanupDram();
+  cleanupFootprint();
+  cleanupSketches();
+  cleanupShadow();
   cleanupCache();
 }
 
-LOCALFUN VOID CacheLoad(ADDRINT addr, UINT32 size)
+LOCALFUN VOID ThreadStart(THREADID tid, CONTEXT * ctxt, INT32 flags, VOID * v)
+{
+  if (!startThreadStats(tid)){
+    std::cerr << "Error, could not allocate the statistics of thread " << tid << "! Aborting...\n";
+    PIN_ExitProcess(1);
+  }
+  if (knob_sweep.NumberOfValues() && !startSweepThread(tid)){
+    std::cerr << "Error, could not allocate the access buffer of thread " << tid << "! Aborting...\n";
+    PIN_ExitProcess(1);
+  }
+}
+
+LOCALFUN VOID ThreadFini(THREADID tid, const CONTEXT * ctxt, INT32 code, VOID * v)
+{
+  finiThreadStats(tid);
+  if (knob_sweep.NumberOfValues())
+    finiSweepThread(tid);
+}
+
+// the engine, statistics level and set index function are template
+// parameters, main picks the instance once, see initCacheParams
+template <bool SHARED, bool FULL, SET_HASH HASH>
+LOCALFUN VOID CacheLoad(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
+{
+  LLCAccess<SHARED, FULL, HASH>(*ThreadStats(tid), addr, size, LOAD_ACCESS, pc);
+}
+
+template <bool SHARED, bool FULL, SET_HASH HASH>
+LOCALFUN VOID CacheStore(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
+{
+  LLCAccess<SHARED, FULL, HASH>(*ThreadStats(tid), addr, size, STORE_ACCESS, pc);
+}
+
+// hits counted without being simulated, on the line lineStart that was
+// just accessed: they are credited to its set in the set profile and
+// move the footprint window, as the simulated hits would
+template <bool SHARED, SET_HASH HASH>
+static inline void RepeatedHits(MEMTRANS_STATS &st, ADDRINT lineStart, UINT64 hits)
+{
+  if (_setPressure && hits){
+    ADDRINT setIndex = SetIndex<HASH>(lineStart >> _lineShift);
+    if (SHARED){
+      SET_LOCK &lock = _setLocks[setIndex & _lockStripeMask];
+      LockStripe(lock);
+      _setPressure[setIndex].accesses += hits;
+      UnlockStripe(lock);
+    }
+    else
+      _setPressure[setIndex].accesses += hits;
+  }
+  if (st.footprint)
+    FootprintRepeat(*st.footprint, lineStart, hits);
+}
+
+// the fetches of a run of instructions on one line (see FetchRuns): the
+// first one accesses the line, the others hit the line it just accessed
+template <bool SHARED, bool FULL, SET_HASH HASH>
+LOCALFUN VOID CacheFetch(ADDRINT pc, ADDRINT addr, UINT32 size, UINT32 fetches, THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  LLCAccess<SHARED, FULL, HASH>(st, addr, size, LOAD_ACCESS, pc);
+  st.LLCHitCount[LOAD_ACCESS] += fetches - 1;
+  if (!SHARED)
+    _accessClock += fetches - 1; // keeps the LRU clock as with one call per instruction
+  RepeatedHits<SHARED, HASH>(st, addr & _notLineMask, fetches - 1);
+}
+
+// shadow store (-shadow_mb) version: the store is simulated before the
+// instruction and its bytes are captured after it, see ShadowCapture
+template <bool SHARED, bool FULL, SET_HASH HASH>
+LOCALFUN VOID CacheStoreShadow(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  LLCAccess<SHARED, FULL, HASH>(st, addr, size, STORE_ACCESS, pc);
+  st.shadowAddr = addr;
+  st.shadowSize = size;
+}
+
+// the effective address is only available before the instruction, so the
+// store leaves it in the thread's statistics block; a store that was not
+// sampled leaves nothing
+template <bool SHARED, SET_HASH HASH>
+LOCALFUN VOID ShadowCapture(THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  if (!st.shadowSize)
+    return;
+  ShadowStore<SHARED, HASH>(st.shadowAddr, st.shadowSize);
+  st.shadowSize = 0;
+}
+
+// the kernel may have written any cached line, see memtrans_shadow.H
+LOCALFUN VOID ShadowSyscallExit(THREADID tid, CONTEXT * ctxt, SYSCALL_STANDARD std, VOID * v)
+{
+  ShadowInvalidateAll();
+}
+
+LOCALFUN VOID ShadowContextChange(THREADID tid, CONTEXT_CHANGE_REASON reason, const CONTEXT * from,
+				  CONTEXT * to, INT32 info, VOID * v)
+{
+  ShadowInvalidateAll();
+}
+
+// gathers, scatters and the other non-standard memory operands: one
+// access per line touched by the active elements, see GroupElements
+template <bool SHARED, bool FULL, SET_HASH HASH>
+LOCALFUN VOID CacheMulti(ADDRINT pc, PIN_MULTI_MEM_ACCESS_INFO * info, THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  LINE_GROUP groups[MAX_LINE_GROUPS];
+  for (UINT32 first = 0; first < info->numberOfMemops; first += MAX_LINE_GROUPS){
+    UINT32 n = GroupElements(st, info, first, groups);
+    for (UINT32 g = 0; g < n; ++g){
+      UINT32 size = (UINT32)(groups[g].hi - groups[g].lo);
+      LLCAccess<SHARED, FULL, HASH>(st, groups[g].lo, size, groups[g].type, pc);
+      if (_shadowLines && groups[g].type == STORE_ACCESS)
+	ShadowDrop<SHARED, HASH>(groups[g].lo, size);
+    }
+  }
+}
+
+// whole REP MOVS/STOS operands, called at the first iteration with the
+// repeat count (see InsertRep): one range access, and the other elements
+// of each line hit. Unlike one call per iteration, the source range is
+// accessed before the destination range, so a MOVS whose two ranges
+// conflict in the LLC sets can hit and miss differently, and with the
+// shared LLC another thread may evict a line before its later elements
+// (which still count as hits); the report says when this path was active
+#define DIRECTION_FLAG 0x400
+
+LOCALFUN ADDRINT FirstRep(BOOL first)
+{
+  return first;
+}
+
+// the range of a whole string operation, walked downwards if DF is set
+static inline UINT64 RepRange(ADDRINT &addr, UINT32 size, ADDRINT count, ADDRINT flags)
+{
+  UINT64 bytes = (UINT64)count * size;
+  if (flags & DIRECTION_FLAG)
+    addr -= bytes - size;
+  return bytes;
+}
+
+template <bool SHARED, bool FULL, SET_HASH HASH>
+LOCALFUN VOID CacheRep(ADDRINT pc, ADDRINT addr, UINT32 size, ADDRINT count, ADDRINT flags, UINT32 type, THREADID tid)
+{
+  if (!count)
+    return;
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  UINT64 bytes = RepRange(addr, size, count, flags);
+  UINT64 lines = ((addr + bytes - 1) >> _lineShift) - (addr >> _lineShift) + 1;
+  LLCAccessRange<SHARED, FULL, HASH>(st, addr, bytes, (ACCESS_TYPE)type, pc);
+  if (count > lines){
+    st.LLCHitCount[type] += count - lines;
+    if (!SHARED)
+      _accessClock += count - lines;
+  }
+  if (_setPressure || st.footprint){
+    // the elements after the first one starting in each line; an element
+    // crossing a line is only counted in its first one
+    ADDRINT lineStart = addr & _notLineMask;
+    for (UINT64 done = 0; done < count; lineStart += _lineSize){
+      ADDRINT lineEnd = std::min(lineStart + _lineSize, addr + bytes);
+      UINT64 starts = std::min((UINT64)count, (UINT64)((lineEnd - addr + size - 1) / size)) - done;
+      if (starts > 1)
+	RepeatedHits<SHARED, HASH>(st, lineStart, starts - 1);
+      done += starts;
+    }
+  }
+}
+
+// tag-only versions for filtered code (-filter_warm 1)
+template <bool SHARED, SET_HASH HASH>
+LOCALFUN VOID CacheFetchWarm(ADDRINT pc, ADDRINT addr, UINT32 size, UINT32 fetches, THREADID tid)
+{
+  WarmAccess<SHARED, HASH>(*ThreadStats(tid), addr, size, LOAD_ACCESS);
+  if (!SHARED)
+    _accessClock += fetches - 1;
+}
+
+template <bool SHARED, SET_HASH HASH>
+LOCALFUN VOID CacheLoadWarm(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
+{
+  WarmAccess<SHARED, HASH>(*ThreadStats(tid), addr, size, LOAD_ACCESS);
+}
+
+template <bool SHARED, SET_HASH HASH>
+LOCALFUN VOID CacheStoreWarm(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
+{
+  WarmAccess<SHARED, HASH>(*ThreadStats(tid), addr, size, STORE_ACCESS);
+}
+
+template <bool SHARED, SET_HASH HASH>
+LOCALFUN VOID CacheMultiWarm(ADDRINT pc, PIN_MULTI_MEM_ACCESS_INFO * info, THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  LINE_GROUP groups[MAX_LINE_GROUPS];
+  for (UINT32 first = 0; first < info->numberOfMemops; first += MAX_LINE_GROUPS){
+    UINT32 n = GroupElements(st, info, first, groups);
+    for (UINT32 g = 0; g < n; ++g)
+      WarmAccess<SHARED, HASH>(st, groups[g].lo, (UINT32)(groups[g].hi - groups[g].lo), groups[g].type);
+  }
+}
+
+template <bool SHARED, SET_HASH HASH>
+LOCALFUN VOID CacheRepWarm(ADDRINT pc, ADDRINT addr, UINT32 size, ADDRINT count, ADDRINT flags, UINT32 type, THREADID tid)
+{
+  if (!count)
+    return;
+  UINT64 bytes = RepRange(addr, size, count, flags);
+  WarmAccess<SHARED, HASH>(*ThreadStats(tid), addr, bytes, (ACCESS_TYPE)type);
+}
+
+// sweep mode (-sweep) versions, the accesses are only recorded
+LOCALFUN VOID SweepLoad(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
 {
-  LLCAccess(addr, size, LOAD_ACCESS);
+  SweepRecord(tid, addr, size, LOAD_ACCESS);
 }
 
-LOCALFUN VOID CacheStore(ADDRINT addr, UINT32 size)
+LOCALFUN VOID SweepStore(ADDRINT pc, ADDRINT addr, UINT32 size, THREADID tid)
 {
-  LLCAccess(addr, size, STORE_ACCESS);
+  SweepRecord(tid, addr, size, STORE_ACCESS);
+}
+
+LOCALFUN VOID SweepMulti(ADDRINT pc, PIN_MULTI_MEM_ACCESS_INFO * info, THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  LINE_GROUP groups[MAX_LINE_GROUPS];
+  for (UINT32 first = 0; first < info->numberOfMemops; first += MAX_LINE_GROUPS){
+    UINT32 n = GroupElements(st, info, first, groups);
+    for (UINT32 g = 0; g < n; ++g)
+      SweepRecord(tid, groups[g].lo, (UINT32)(groups[g].hi - groups[g].lo), groups[g].type);
+  }
+}
+
+// the analysis routines, indexed by [set index function][shared LLC][full statistics]
+#define ENGINE_FUNS_HASH(F, HASH) \
+  {{(AFUNPTR)F<false, false, HASH>, (AFUNPTR)F<false, true, HASH>}, \
+   {(AFUNPTR)F<true, false, HASH>, (AFUNPTR)F<true, true, HASH>}}
+#define ENGINE_FUNS(F) { \
+  ENGINE_FUNS_HASH(F, SET_HASH_MODULO), ENGINE_FUNS_HASH(F, SET_HASH_XOR), \
+  ENGINE_FUNS_HASH(F, SET_HASH_PRIME), ENGINE_FUNS_HASH(F, SET_HASH_SLICE)}
+// and the tag-only ones, by [set index function][shared LLC]
+#define WARM_FUNS(F) { \
+  {(AFUNPTR)F<false, SET_HASH_MODULO>, (AFUNPTR)F<true, SET_HASH_MODULO>}, \
+  {(AFUNPTR)F<false, SET_HASH_XOR>, (AFUNPTR)F<true, SET_HASH_XOR>}, \
+  {(AFUNPTR)F<false, SET_HASH_PRIME>, (AFUNPTR)F<true, SET_HASH_PRIME>}, \
+  {(AFUNPTR)F<false, SET_HASH_SLICE>, (AFUNPTR)F<true, SET_HASH_SLICE>}}
+
+LOCALVAR const AFUNPTR cacheLoadFuns[SET_HASHES][2][2] = ENGINE_FUNS(CacheLoad);
+LOCALVAR const AFUNPTR cacheStoreFuns[SET_HASHES][2][2] = ENGINE_FUNS(CacheStore);
+LOCALVAR const AFUNPTR cacheFetchFuns[SET_HASHES][2][2] = ENGINE_FUNS(CacheFetch);
+LOCALVAR const AFUNPTR cacheMultiFuns[SET_HASHES][2][2] = ENGINE_FUNS(CacheMulti);
+LOCALVAR const AFUNPTR cacheRepFuns[SET_HASHES][2][2] = ENGINE_FUNS(CacheRep);
+LOCALVAR const AFUNPTR cacheStoreShadowFuns[SET_HASHES][2][2] = ENGINE_FUNS(CacheStoreShadow);
+LOCALVAR const AFUNPTR warmLoadFuns[SET_HASHES][2] = WARM_FUNS(CacheLoadWarm);
+LOCALVAR const AFUNPTR warmStoreFuns[SET_HASHES][2] = WARM_FUNS(CacheStoreWarm);
+LOCALVAR const AFUNPTR warmFetchFuns[SET_HASHES][2] = WARM_FUNS(CacheFetchWarm);
+LOCALVAR const AFUNPTR warmMultiFuns[SET_HASHES][2] = WARM_FUNS(CacheMultiWarm);
+LOCALVAR const AFUNPTR warmRepFuns[SET_HASHES][2] = WARM_FUNS(CacheRepWarm);
+LOCALVAR const AFUNPTR shadowCaptureFuns[SET_HASHES][2] = WARM_FUNS(ShadowCapture);
+
+// instruction count of the telemetry, one call per basic block
+LOCALFUN VOID CountInstructions(UINT32 numIns, THREADID tid)
+{
+  ThreadStats(tid)->instructions += numIns;
+}
+
+// with -converge_error each thread also checks the convergence windows
+// every convergeStep instructions, and detaches the tool once they converge
+LOCALFUN VOID CountInstructionsConverge(UINT32 numIns, THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  st.instructions += numIns;
+  if (st.instructions < st.convergeNext)
+    return;
+  st.convergeNext = st.instructions + convergeStep;
+  if (convergeCheck(tid))
+    PIN_Detach();
+}
+
+LOCALFUN VOID CountTrace(TRACE trace, VOID * v)
+{
+  AFUNPTR count = CONVERGE::enabled ? (AFUNPTR)CountInstructionsConverge : (AFUNPTR)CountInstructions;
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl))
+    BBL_InsertCall(bbl, IPOINT_BEFORE, count,
+		   IARG_UINT32, BBL_NumIns(bbl), IARG_THREAD_ID, IARG_END);
+}
+
+// Fini is not called after PIN_Detach, the statistics are written here
+LOCALFUN VOID DetachFini(VOID * v)
+{
+  if (!knob_telemetry.Value().empty())
+    stopTelemetry(v);
+  Fini(0, v);
+}
+
+AFUNPTR cacheLoadFun = cacheLoadFuns[SET_HASH_MODULO][0][1];
+AFUNPTR cacheStoreFun = cacheStoreFuns[SET_HASH_MODULO][0][1];
+AFUNPTR cacheFetchFun = cacheFetchFuns[SET_HASH_MODULO][0][1];
+AFUNPTR warmLoadFun = warmLoadFuns[SET_HASH_MODULO][0];
+AFUNPTR warmStoreFun = warmStoreFuns[SET_HASH_MODULO][0];
+AFUNPTR warmFetchFun = warmFetchFuns[SET_HASH_MODULO][0];
+AFUNPTR cacheMultiFun = cacheMultiFuns[SET_HASH_MODULO][0][1];
+AFUNPTR cacheRepFun = cacheRepFuns[SET_HASH_MODULO][0][1];
+AFUNPTR warmRepFun = warmRepFuns[SET_HASH_MODULO][0];
+AFUNPTR warmMultiFun = warmMultiFuns[SET_HASH_MODULO][0];
+AFUNPTR shadowCaptureFun = NULL; // non-NULL with the shadow store
+
+// -sample_period: the first sampleOn accesses of every samplePeriod
+// accesses of a thread are simulated, the others are skipped
+LOCALFUN ADDRINT SampleIf(THREADID tid)
+{
+  MEMTRANS_STATS &st = *ThreadStats(tid);
+  UINT64 clock = st.sampleClock;
+  st.sampleClock = (clock + 1 == samplePeriod) ? 0 : clock + 1;
+  return clock < sampleOn;
+}
+
+// inserts an access call with the arguments args, behind the SampleIf
+// call when sampling is on
+LOCALFUN VOID InsertAccess(INS ins, AFUNPTR fun, bool predicated, IARGLIST args)
+{
+  if (samplePeriod){
+    if (predicated){
+      INS_InsertIfPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR)SampleIf, IARG_THREAD_ID, IARG_END);
+      INS_InsertThenPredicatedCall(ins, IPOINT_BEFORE, fun, IARG_IARGLIST, args, IARG_END);
+    }
+    else{
+      INS_InsertIfCall(ins, IPOINT_BEFORE, (AFUNPTR)SampleIf, IARG_THREAD_ID, IARG_END);
+      INS_InsertThenCall(ins, IPOINT_BEFORE, fun, IARG_IARGLIST, args, IARG_END);
+    }
+  }
+  else if (predicated)
+    INS_InsertPredicatedCall(ins, IPOINT_BEFORE, fun, IARG_IARGLIST, args, IARG_END);
+  else
+    INS_InsertCall(ins, IPOINT_BEFORE, fun, IARG_IARGLIST, args, IARG_END);
+  IARGLIST_Free(args);
+}
+
+// inserts the whole-string call of a REP operand, ea and size are the
+// IARG_MEMORYREAD or IARG_MEMORYWRITE arguments of the operand
+LOCALFUN VOID InsertRep(INS ins, AFUNPTR fun, IARG_TYPE ea, IARG_TYPE size, ACCESS_TYPE type)
+{
+  INS_InsertIfPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR)FirstRep, IARG_FIRST_REP_ITERATION, IARG_END);
+  INS_InsertThenPredicatedCall(ins, IPOINT_BEFORE, fun,
+			       IARG_INST_PTR,
+			       ea,
+			       size,
+			       IARG_REG_VALUE, INS_RepCountRegister(ins),
+			       IARG_REG_VALUE, REG_GFLAGS,
+			       IARG_UINT32, type,
+			       IARG_THREAD_ID,
+			       IARG_END);
 }
 
 LOCALFUN VOID Instruction(INS ins, VOID *v)
@@ -174,14 +904,37 @@ LOCALFUN VOID Instruction(INS ins, VOID *v)
   // normalize against the number of instructions, so we must
   // also have an instruction count. E.g. MPI: misses/inst.
 
-  // all instruction fetches access I-cache
-  if(knob_sim_inst == 1)
-    INS_InsertCall(
-		   ins, IPOINT_BEFORE, (AFUNPTR)CacheLoad,
-		   IARG_INST_PTR,
-		   IARG_UINT32, INS_Size(ins),
-		   IARG_END);
-  if (INS_IsMemoryRead(ins) && INS_IsStandardMemop(ins))
+  // the ROI triggers are always instrumented, the simulation only inside the ROI
+  RoiInstrument(ins);
+  if (!ROI::active)
+    return;
+
+  // filtered code gets no analysis calls, or only the tag-only ones
+  FILTER_ACTION action = FilterIns(ins);
+  if (action == FILTER_DROP)
+    return;
+  AFUNPTR loadFun = (action == FILTER_WARM) ? warmLoadFun : cacheLoadFun;
+  AFUNPTR storeFun = (action == FILTER_WARM) ? warmStoreFun : cacheStoreFun;
+  AFUNPTR repFun = (action == FILTER_WARM) ? warmRepFun : cacheRepFun;
+  // REP MOVS/STOS (the string operations that write) always run their
+  // whole count, so they are simulated at once at the first iteration
+  bool wholeRep = repRange && INS_HasRealRep(ins) && INS_IsMemoryWrite(ins);
+
+  // all instruction fetches access I-cache, here one call per instruction
+  // unless they are simulated per basic block (see FetchRuns)
+  if(knob_sim_inst == 1 && !bblFetch){
+    IARGLIST args = IARGLIST_Alloc();
+    IARGLIST_AddArguments(args,
+			  IARG_INST_PTR,
+			  IARG_INST_PTR,
+			  IARG_UINT32, INS_Size(ins),
+			  IARG_THREAD_ID,
+			  IARG_END);
+    InsertAccess(ins, loadFun, false, args);
+  }
+  if (INS_IsMemoryRead(ins) && INS_IsStandardMemop(ins) && wholeRep)
+    InsertRep(ins, repFun, IARG_MEMORYREAD_EA, IARG_MEMORYREAD_SIZE, LOAD_ACCESS);
+  else if (INS_IsMemoryRead(ins) && INS_IsStandardMemop(ins))
     {
       //TODO: this part can be slightly optimized by adding another
       //analysis function where the memory access covers only a single
@@ -189,14 +942,19 @@ LOCALFUN VOID Instruction(INS ins, VOID *v)
       
       // only predicated-on memory instructions access D-cache
       //      UINT32 size = INS_MemoryReadSize(ins);
-      INS_InsertPredicatedCall(
-			       ins, IPOINT_BEFORE, (AFUNPTR)CacheLoad,
-			       IARG_MEMORYREAD_EA,
-			       IARG_MEMORYREAD_SIZE,
-			       IARG_END);
+      IARGLIST args = IARGLIST_Alloc();
+      IARGLIST_AddArguments(args,
+			    IARG_INST_PTR,
+			    IARG_MEMORYREAD_EA,
+			    IARG_MEMORYREAD_SIZE,
+			    IARG_THREAD_ID,
+			    IARG_END);
+      InsertAccess(ins, loadFun, true, args);
     }
 
-  if (INS_IsMemoryWrite(ins) && INS_IsStandardMemop(ins))
+  if (INS_IsMemoryWrite(ins) && INS_IsStandardMemop(ins) && wholeRep)
+    InsertRep(ins, repFun, IARG_MEMORYWRITE_EA, IARG_MEMORYWRITE_SIZE, STORE_ACCESS);
+  else if (INS_IsMemoryWrite(ins) && INS_IsStandardMemop(ins))
     {
       //TODO: this part can be slightly optimized by adding another
       //analysis function where the memory access covers only a single
@@ -204,18 +962,160 @@ LOCALFUN VOID Instruction(INS ins, VOID *v)
 
       // only predicated-on memory instructions access D-cache
       //      UINT32 size = INS_MemoryWriteSize(ins);
-	INS_InsertPredicatedCall(
-				 ins, IPOINT_BEFORE, (AFUNPTR)CacheStore,
-				 IARG_MEMORYWRITE_EA,
-				 IARG_MEMORYWRITE_SIZE,
-				 IARG_END);
+      IARGLIST args = IARGLIST_Alloc();
+      IARGLIST_AddArguments(args,
+			    IARG_INST_PTR,
+			    IARG_MEMORYWRITE_EA,
+			    IARG_MEMORYWRITE_SIZE,
+			    IARG_THREAD_ID,
+			    IARG_END);
+      InsertAccess(ins, storeFun, true, args);
+      // the written bytes go to the shadow store once the store is done;
+      // instructions without a fall-through (call) are caught at their target
+      if (shadowCaptureFun && action == FILTER_SIMULATE){
+	if (INS_IsValidForIpointAfter(ins))
+	  INS_InsertPredicatedCall(ins, IPOINT_AFTER, shadowCaptureFun, IARG_THREAD_ID, IARG_END);
+	if (INS_IsValidForIpointTakenBranch(ins))
+	  INS_InsertPredicatedCall(ins, IPOINT_TAKEN_BRANCH, shadowCaptureFun, IARG_THREAD_ID, IARG_END);
+      }
+    }
+
+  // gathers, scatters, masked vector moves...: Pin describes each element
+  if ((INS_IsMemoryRead(ins) || INS_IsMemoryWrite(ins)) && !INS_IsStandardMemop(ins))
+    {
+      IARGLIST args = IARGLIST_Alloc();
+      IARGLIST_AddArguments(args,
+			    IARG_INST_PTR,
+			    IARG_MULTI_MEMORYACCESS_EA,
+			    IARG_THREAD_ID,
+			    IARG_END);
+      InsertAccess(ins, (action == FILTER_WARM) ? warmMultiFun : cacheMultiFun, true, args);
+    }
+}
+
+// a run of instruction fetches on one line, inserted before its first instruction
+typedef struct FETCH_RUN
+{
+  INS ins;
+  ADDRINT start, end;
+  UINT32 fetches;
+  FILTER_ACTION action;
+}FETCH_RUN;
+
+LOCALFUN VOID InsertFetchRun(const FETCH_RUN &run)
+{
+  INS_InsertCall(run.ins, IPOINT_BEFORE, run.action == FILTER_WARM ? warmFetchFun : cacheFetchFun,
+		 IARG_INST_PTR,
+		 IARG_ADDRINT, run.start,
+		 IARG_UINT32, (UINT32)(run.end - run.start),
+		 IARG_UINT32, run.fetches,
+		 IARG_THREAD_ID,
+		 IARG_END);
+}
+
+/*!
+ *  Instruments the instruction fetches of a basic block (-ic_bbl 1). The
+ *  block is split at instrumentation time into runs of consecutive fetches
+ *  on the same line, and each run is one call that accesses the line once
+ *  and counts the other fetches as the hits they are. A run ends at a line
+ *  change, at a memory instruction (its data accesses must come after the
+ *  fetches before them), at a REP instruction (whose calls are made per
+ *  iteration) and where the filter action changes. With a private LLC the
+ *  counts are then the same as with one call per instruction; with the
+ *  shared LLC they are not exact, as another thread may evict the line
+ *  between the fetches of a run, which still count as hits, and the line
+ *  gets one LRU stamp per run. The report says when batching was active.
+ */
+LOCALFUN VOID FetchRuns(BBL bbl)
+{
+  FETCH_RUN run;
+  bool open = false;
+  for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)){
+    FILTER_ACTION action = FilterIns(ins);
+    bool alone = INS_HasRealRep(ins);
+    ADDRINT pos = INS_Address(ins);
+    ADDRINT end = pos + INS_Size(ins);
+    if (action == FILTER_DROP || alone){
+      if (open)
+	InsertFetchRun(run);
+      open = false;
+      if (action == FILTER_DROP)
+	continue;
+    }
+    // an instruction that crosses a line ends one run and starts the next
+    while (pos < end){
+      ADDRINT lineEnd = (pos & LLC::notLineMask) + LLC::lineSize;
+      ADDRINT partEnd = std::min(end, lineEnd);
+      if (open && run.end == pos && (pos & LLC::notLineMask) == (run.start & LLC::notLineMask) &&
+	  run.action == action){
+	run.end = partEnd;
+	run.fetches++;
+      }
+      else{
+	if (open)
+	  InsertFetchRun(run);
+	run.ins = ins;
+	run.start = pos;
+	run.end = partEnd;
+	run.fetches = 1;
+	run.action = action;
+	open = true;
+      }
+      pos = partEnd;
     }
+    if (alone || INS_IsMemoryRead(ins) || INS_IsMemoryWrite(ins)){
+      InsertFetchRun(run);
+      open = false;
+    }
+  }
+  if (open)
+    InsertFetchRun(run);
+}
+
+LOCALFUN VOID Trace(TRACE trace, VOID *v)
+{
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)){
+    // the fetch calls go first, so they run before the data accesses
+    // of the same instruction
+    if (bblFetch && ROI::active)
+      FetchRuns(bbl);
+    for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins))
+      Instruction(ins, v);
+  }
 }
 
 bool initCacheParams(void)
 {
   start = clock();
-  LLC::associativity = knob_associativity.Value();
+  // the direct-mapped engine is the set-associative one with a single way
+  if (knob_engine.Value() == "direct")
+    LLC::associativity = 1;
+  else if (knob_engine.Value() == "set")
+    LLC::associativity = knob_associativity.Value();
+  else{
+    std::cout << "Error, unknown cache engine " << knob_engine.Value() << "! Aborting...\n";
+    return false;
+  }
+  if (knob_stats.Value() != "full" && knob_stats.Value() != "basic"){
+    std::cout << "Error, unknown statistics level " << knob_stats.Value() << "! Aborting...\n";
+    return false;
+  }
+  if (knob_format.Value() != "multi" && knob_format.Value() != "legacy"){
+    std::cout << "Error, unknown output format " << knob_format.Value() << "! Aborting...\n";
+    return false;
+  }
+  fullStats = (knob_stats.Value() == "full");
+  legacyFormat = (knob_format.Value() == "legacy");
+  if (legacyFormat && !fullStats){
+    std::cout << "Error, the legacy output format needs the full statistics level! Aborting...\n";
+    return false;
+  }
+  sampleOn = knob_sample_on.Value();
+  samplePeriod = knob_sample_period.Value();
+  if (samplePeriod && (sampleOn == 0 || sampleOn > samplePeriod)){
+    std::cout << "Error, -sample_on must be between 1 and -sample_period! Aborting...\n";
+    return false;
+  }
   LLC::cacheSize = knob_size.Value()/LLC::associativity;
   LLC::lineSize = knob_line_size.Value();
 
@@ -229,6 +1129,17 @@ bool initCacheParams(void)
     return false;
   }
 
+  if ( LLC::lineSize > MAX_LINE_SIZE ){
+    std::cout << "Error, line size can be at most " << MAX_LINE_SIZE << " B! Aborting...\n";
+    return false;
+  }
+
+  UINT32 sectorSize = knob_sector_size.Value();
+  if ( sectorSize && (!IsPower2(sectorSize) || sectorSize < 8 || sectorSize > 64 || sectorSize >= LLC::lineSize) ){
+    std::cout << "Error, sector size must be a power of 2 between 8 and 64 B, and smaller than the line size! Aborting...\n";
+    return false;
+  }
+
   if ( !IsPower2(LLC::cacheSize / LLC::lineSize) ){
     std::cout << "Error, (cache size / line size) must be a power of 2! Aborting...\n";
     return false;
@@ -237,12 +1148,162 @@ bool initCacheParams(void)
   LLC::notLineMask = ~(((ADDRINT)(LLC::lineSize)) - 1);
   LLC::max_sets = LLC::cacheSize / (LLC::lineSize);
   
-  lineBytes = new UINT8[LLC::lineSize];
-  
   out.open(knob_output.Value().c_str());
 
-  initCache(LLC::cacheSize, LLC::lineSize, LLC::max_sets, LLC::associativity); 
+  if (!initCache(LLC::cacheSize, LLC::lineSize, LLC::max_sets, LLC::associativity, sectorSize)){
+    std::cout << "Error, could not reserve memory for the cache sets! Aborting...\n";
+    return false;
+  }
+  if (knob_shared_llc.Value()){
+    if (!IsPower2(knob_llc_locks.Value()) || knob_llc_locks.Value() == 0){
+      std::cout << "Error, the number of LLC lock stripes must be a power of 2! Aborting...\n";
+      return false;
+    }
+    if (!initSetLocks(knob_llc_locks.Value())){
+      std::cout << "Error, could not allocate the LLC set locks! Aborting...\n";
+      return false;
+    }
+  }
+  if (!initSetHash(knob_set_hash.Value(), knob_llc_slice_masks.Value()))
+    return false;
+  if (knob_set_profile.Value() && !initSetProfile(knob_set_profile_top.Value())){
+    std::cout << "Error, could not reserve memory for the per-set counters! Aborting...\n";
+    return false;
+  }
+  // the analysis routines are chosen once here, so the default
+  // single-threaded mode has no locking on its access path, the basic
+  // statistics level no histogram updates and the modulo index no hashing
+  SET_HASH hash = SETS::hash;
+  BOOL shared = knob_shared_llc.Value();
+  cacheLoadFun = cacheLoadFuns[hash][shared][fullStats];
+  cacheStoreFun = cacheStoreFuns[hash][shared][fullStats];
+  cacheFetchFun = cacheFetchFuns[hash][shared][fullStats];
+  cacheMultiFun = cacheMultiFuns[hash][shared][fullStats];
+  cacheRepFun = cacheRepFuns[hash][shared][fullStats];
+  warmLoadFun = warmLoadFuns[hash][shared];
+  warmStoreFun = warmStoreFuns[hash][shared];
+  warmFetchFun = warmFetchFuns[hash][shared];
+  warmMultiFun = warmMultiFuns[hash][shared];
+  warmRepFun = warmRepFuns[hash][shared];
+
+  if (knob_sweep.NumberOfValues()){
+    if (knob_filter_warm.Value()){
+      std::cout << "Error, -filter_warm is not supported with -sweep! Aborting...\n";
+      return false;
+    }
+    if (hash != SET_HASH_MODULO || knob_set_profile.Value()){
+      std::cout << "Error, -set_hash and -set_profile are not supported with -sweep! Aborting...\n";
+      return false;
+    }
+    if (!initSweep(knob_sweep, knob_sweep_buffer.Value()))
+      return false;
+    cacheLoadFun = (AFUNPTR)SweepLoad;
+    cacheStoreFun = (AFUNPTR)SweepStore;
+    cacheMultiFun = (AFUNPTR)SweepMulti;
+  }
+
+  if (knob_shadow_mb.Value()){
+    if (knob_sweep.NumberOfValues()){
+      std::cout << "Error, -shadow_mb is not supported with -sweep! Aborting...\n";
+      return false;
+    }
+    // the stores of the skipped accesses would leave stale slots
+    if (samplePeriod){
+      std::cout << "Error, -shadow_mb is not supported with -sample_period! Aborting...\n";
+      return false;
+    }
+    if (!initShadow(LLC::max_sets * LLC::associativity, (UINT64)knob_shadow_mb.Value() << 20)){
+      std::cout << "Error, the shadow store of this LLC needs " << ((_shadowBytes + (1 << 20) - 1) >> 20)
+		<< " MB, more than -shadow_mb or what could be reserved! Aborting...\n";
+      return false;
+    }
+    cacheStoreFun = cacheStoreShadowFuns[hash][shared][fullStats];
+    shadowCaptureFun = shadowCaptureFuns[hash][shared];
+  }
+
+  if (!initFilter(knob_filter_img_include, knob_filter_img_exclude,
+		  knob_filter_rtn_include, knob_filter_rtn_exclude,
+		  knob_filter_range_include, knob_filter_range_exclude,
+		  knob_filter_warm.Value()))
+    return false;
+  // dropped code is not instrumented, so its stores would leave stale slots
+  if (_shadowLines && FILTER::enabled && !FILTER::warm){
+    std::cout << "Error, -shadow_mb needs -filter_warm 1 with the filters! Aborting...\n";
+    return false;
+  }
+
+  ROI_MARKER marker = ROI_MARKER_NONE;
+  if (knob_roi_marker.Value() == "xchg")
+    marker = ROI_MARKER_XCHG;
+  else if (knob_roi_marker.Value() == "ssc")
+    marker = ROI_MARKER_SSC;
+  else if (knob_roi_marker.Value() != "none"){
+    std::cout << "Error, unknown ROI marker " << knob_roi_marker.Value() << "! Aborting...\n";
+    return false;
+  }
+  initRoi(knob_roi_rtn.Value(), knob_roi_start_pc.Value(), knob_roi_stop_pc.Value(),
+	  knob_roi_start_icount.Value(), knob_roi_stop_icount.Value(), marker);
+  ROI::sscStart = knob_roi_ssc_start.Value();
+  ROI::sscStop = knob_roi_ssc_stop.Value();
+
+  if (knob_alloc_sites.Value() && !initAlloc())
+    return false;
+  _compression = knob_compress.Value();
+  if (knob_memo_entries.Value() && !IsPower2(knob_memo_entries.Value())){
+    std::cout << "Error, the number of memo table entries must be a power of 2! Aborting...\n";
+    return false;
+  }
+  initMemo(knob_memo_entries.Value());
+  if (knob_footprint.Value() &&
+      !initFootprint(knob_footprint_page.Value(), knob_footprint_window.Value(), knob_footprint_hll_error.Value()))
+    return false;
+  if (!knob_sketch.Value().empty() &&
+      !initSketches(knob_sketch.Value(), knob_sketch_eps.Value(), knob_sketch_delta.Value(),
+		    knob_sketch_topk.Value(), knob_sketch_hll_error.Value()))
+    return false;
+  if (!initPrefetchers(knob_pf_next_lines.Value(), knob_pf_stride_entries.Value(), knob_pf_stride_degree.Value(),
+		       knob_pf_streams.Value(), knob_pf_stream_depth.Value(), knob_pf_latency.Value()))
+    return false;
+  // the per-PC prefetchers, the sampling clock and the sweep buffers see
+  // every fetch, so they keep the per-instruction calls
+  bblFetch = knob_sim_inst.Value() && knob_ic_bbl.Value() && !_prefetching && !samplePeriod &&
+    !knob_sweep.NumberOfValues();
+  // the sampling clock and the sweep buffers count the iterations, and the
+  // shadow store captures the stores one by one
+  repRange = !samplePeriod && !knob_sweep.NumberOfValues() && !knob_shadow_mb.Value();
+  if ((knob_heatmap.Value() || !knob_heatmap_file.Value().empty()) && !initHeatmap(knob_heatmap_page.Value()))
+    return false;
+  if (knob_dram.Value() &&
+      !initDram(knob_dram_channels.Value(), knob_dram_ranks.Value(), knob_dram_banks.Value(), knob_dram_row.Value(),
+		knob_dram_map.Value(), knob_dram_xor.Value(), knob_dram_page.Value(), knob_dram_queue.Value(),
+		knob_dram_timing.Value(), knob_dram_interval.Value()))
+    return false;
+  if (knob_converge_error.Value() != 0){
+    if (knob_sweep.NumberOfValues()){
+      std::cout << "Error, -converge_error is not supported with -sweep! Aborting...\n";
+      return false;
+    }
+    if (!initConverge(knob_converge_error.Value(), knob_converge_window.Value(), knob_converge_min_windows.Value(),
+		      knob_converge_z.Value(), knob_converge_metrics.Value()))
+      return false;
+    convergeStep = knob_converge_window.Value() / 8 ? knob_converge_window.Value() / 8 : 1;
+  }
+  if (!knob_telemetry.Value().empty() &&
+      !initTelemetry(knob_telemetry.Value(), knob_telemetry_ms.Value(), knob_telemetry_hist.Value()))
+    return false;
+
   fill_hamming_lut();
+  initStats();
+
+  // the restore needs the cache regions and the cleared statistics
+  if (!knob_ckpt_restore.Value().empty() &&
+      !restoreCheckpoint(knob_ckpt_restore.Value(), knob_ckpt_restore_stats.Value()))
+    return false;
+  if (!knob_ckpt_save.Value().empty() && knob_ckpt_at_roi_exit.Value())
+    ROI::exitHook = CheckpointAtRoiExit;
+  // the code outside the ROI is not instrumented
+  if (_shadowLines)
+    ROI::enterHook = ShadowInvalidateAll;
   return true;
 }
 
@@ -258,11 +1319,65 @@ GLOBALFUN int main(int argc, char *argv[])
   std::cout << "Cache size: " << LLC::cacheSize*LLC::associativity << " B\n";
   std::cout << "Associativity: " << LLC::associativity << (LLC::associativity == 1 ? " way\n" : " ways\n");
   std::cout << "Line size: " << LLC::lineSize << " B\n";
-  std::cout << "Instructions cache simulation: " << (knob_sim_inst.Value() == 0 ? "off\n\n" : "on\n\n");
+  if (knob_sector_size.Value())
+    std::cout << "Sector size: " << knob_sector_size.Value() << " B\n";
+  if (knob_shared_llc.Value())
+    std::cout << "Shared LLC mode: on (" << knob_llc_locks.Value() << " lock stripes)\n";
+  std::cout << "Instructions cache simulation: " << (knob_sim_inst.Value() == 0 ? "off\n" :
+							bblFetch ? "on (per basic block)\n" : "on\n");
+  std::cout << "Statistics level: " << knob_stats.Value() << ", output format: " << knob_format.Value() << "\n";
+  if (samplePeriod)
+    std::cout << "Sampling: " << sampleOn << " of every " << samplePeriod << " accesses\n";
+  if (knob_alloc_sites.Value())
+    std::cout << "Allocation sites: top " << knob_alloc_sites.Value() << "\n";
+  if (_prefetching)
+    std::cout << "Prefetchers: next-line " << knob_pf_next_lines.Value()
+	      << ", stride " << knob_pf_stride_entries.Value() << "x" << knob_pf_stride_degree.Value()
+	      << ", stream " << knob_pf_streams.Value() << "x" << knob_pf_stream_depth.Value() << "\n";
+  if (knob_dram.Value())
+    std::cout << "DRAM: " << knob_dram_channels.Value() << " channels x " << knob_dram_ranks.Value() << " ranks x "
+	      << knob_dram_banks.Value() << " banks, " << knob_dram_map.Value() << ", " << knob_dram_page.Value() << " page\n";
+  if (!knob_telemetry.Value().empty())
+    std::cout << "Telemetry: " << knob_telemetry.Value() << " every " << knob_telemetry_ms.Value() << " ms\n";
+  if (FOOTPRINT_EST::enabled)
+    std::cout << "Footprint: " << knob_footprint_page.Value() << " B pages, windows of "
+	      << knob_footprint_window.Value() << " line accesses\n";
+  if (SKETCH::enabled)
+    std::cout << "Word sketches: " << knob_sketch.Value() << " bit, top " << SKETCH::topK << "\n";
+  if (knob_shadow_mb.Value())
+    std::cout << "Shadow store: " << (_shadowBytes >> 10) << " KB\n";
+  if (CONVERGE::enabled)
+    std::cout << "Convergence: " << knob_converge_metrics.Value() << " within " << knob_converge_error.Value() * 100
+	      << "%, windows of " << knob_converge_window.Value() << " instructions\n";
+  if (!knob_ckpt_restore.Value().empty())
+    std::cout << "Warm start from: " << knob_ckpt_restore.Value() << "\n";
+  for (UINT32 i = 0; i < knob_sweep.NumberOfValues(); ++i)
+    std::cout << "LLC configuration " << i << ": " << knob_sweep.Value(i) << "\n";
+  std::cout << "ROI: " << (ROI::active ? "whole run\n\n" : "triggered\n\n");
 
-  INS_AddInstrumentFunction(Instruction, 0);
+  TRACE_AddInstrumentFunction(Trace, 0);
+  TRACE_AddInstrumentFunction(RoiTrace, 0);
+  IMG_AddInstrumentFunction(RoiImage, 0);
+  PIN_AddThreadStartFunction(ThreadStart, 0);
+  PIN_AddThreadFiniFunction(ThreadFini, 0);
+  if (knob_sweep.NumberOfValues())
+    PIN_AddPrepareForFiniFunction(stopSweep, 0);
+  if (!knob_telemetry.Value().empty() || CONVERGE::enabled)
+    TRACE_AddInstrumentFunction(CountTrace, 0);
+  if (!knob_telemetry.Value().empty())
+    PIN_AddPrepareForFiniFunction(stopTelemetry, 0);
+  if (CONVERGE::enabled)
+    PIN_AddDetachFunction(DetachFini, 0);
+  if (_shadowLines){
+    PIN_AddSyscallExitFunction(ShadowSyscallExit, 0);
+    PIN_AddContextChangeFunction(ShadowContextChange, 0);
+  }
   PIN_AddFiniFunction(Fini, 0);
 
+#ifdef MEMTRANS_PINPLAY
+  pinplay_engine.Activate(argc, argv, knob_logger, knob_replayer);
+#endif
+
   // Never returns
   PIN_StartProgram();
 
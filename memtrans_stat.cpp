@@ -0,0 +1,175 @@
+/*BEGIN_LEGAL 
+  Intel Open Source License 
+
+  Copyright (c) 2002-2017 Intel Corporation. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  Redistributions of source code must retain the above copyright notice,
+  this list of conditions and the following disclaimer.  Redistributions
+  in binary form must reproduce the above copyright notice, this list of
+  conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.  Neither the name of
+  the Intel Corporation nor the names of its contributors may be used to
+  endorse or promote products derived from this software without
+  specific prior written permission.
+ 
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE INTEL OR
+  ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  END_LEGAL */
+/*! @file
+ *  memtrans_stat: reads the live statistics that the memtrans tool
+ *  publishes with -telemetry.
+ *
+ *  Usage: memtrans_stat [-n region] [-i seconds] [-H] [-u]
+ *    -n  the shared-memory region (default /memtrans)
+ *    -i  stream the rates every this many seconds until the run finishes
+ *        (default: print the current statistics once)
+ *    -H  also print the byte value histogram (needs -telemetry_hist 1)
+ *    -u  remove the region after reading it
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "memtrans_telemetry_layout.H"
+
+// seqlock read of the region (and of the histograms if hist is not NULL)
+static void readRegion(const TELEMETRY_REGION * r, TELEMETRY_REGION &copy, uint64_t * hist)
+{
+  uint64_t before, after;
+  do{
+    before = r->sequence;
+    __sync_synchronize();
+    memcpy(&copy, (const void*)r, sizeof(copy));
+    if (hist)
+      memcpy(hist, (const void*)(r + 1), TELEMETRY_HISTOGRAM_WORDS * sizeof(uint64_t));
+    __sync_synchronize();
+    after = r->sequence;
+  } while ((before & 1) || before != after);
+}
+
+static void printStats(const TELEMETRY_REGION &s)
+{
+  uint64_t misses = s.loadMisses + s.storeMisses;
+  uint64_t accesses = misses + s.loadHits + s.storeHits;
+  std::cout << "pid " << s.pid << ", update " << s.updates << ", "
+	    << (double)(s.timeNs - s.startNs) / 1e9 << " s, " << (s.finished ? "finished\n" : "running\n");
+  std::cout << "Instructions: " << s.instructions << "\n";
+  std::cout << "LLC Load Miss Count: " << s.loadMisses << "\n";
+  std::cout << "LLC Load Hit Count: " << s.loadHits << "\n";
+  std::cout << "LLC Store Miss Count: " << s.storeMisses << "\n";
+  std::cout << "LLC Store Hit Count: " << s.storeHits << "\n";
+  std::cout << "LLC Store Evict Count: " << s.evictions << "\n";
+  std::cout << "LLC Total Miss Ratio: " << ((double)misses / (double)accesses)*100 << "%\n";
+  std::cout << "Total number of bit transitions: " << s.transitions << "\n";
+  std::cout << "Bit entropy: " << s.entropy << "\n";
+  if (s.uniqueLines)
+    std::cout << "Footprint: " << (uint64_t)s.uniqueLines << " unique lines, "
+	      << (uint64_t)s.uniquePages << " unique pages\n";
+}
+
+// rates between two updates
+static void printRates(const TELEMETRY_REGION &a, const TELEMETRY_REGION &b)
+{
+  double seconds = (double)(b.timeNs - a.timeNs) / 1e9;
+  if (seconds <= 0)
+    return;
+  uint64_t misses = (b.loadMisses + b.storeMisses) - (a.loadMisses + a.storeMisses);
+  uint64_t accesses = misses + (b.loadHits + b.storeHits) - (a.loadHits + a.storeHits);
+  std::cout << std::setw(10) << std::fixed << std::setprecision(1) << (double)(b.timeNs - b.startNs) / 1e9
+	    << std::setw(10) << std::setprecision(2) << (double)(b.instructions - a.instructions) / seconds / 1e6
+	    << std::setw(12) << std::setprecision(0) << (double)accesses / seconds
+	    << std::setw(12) << (double)misses / seconds
+	    << std::setw(8) << std::setprecision(2) << (accesses ? (double)misses / (double)accesses * 100 : 0.0)
+	    << std::setw(14) << std::setprecision(0) << (double)(b.transitions - a.transitions) / seconds
+	    << std::setw(9) << std::setprecision(4) << b.entropy << "\n";
+  std::cout.unsetf(std::ios::floatfield);
+}
+
+int main(int argc, char * argv[])
+{
+  std::string name = TELEMETRY_DEFAULT_NAME;
+  double interval = 0;
+  bool histogram = false, unlink = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:i:Hu")) != -1){
+    switch (opt){
+    case 'n': name = optarg; break;
+    case 'i': interval = atof(optarg); break;
+    case 'H': histogram = true; break;
+    case 'u': unlink = true; break;
+    default:
+      std::cerr << "Usage: " << argv[0] << " [-n region] [-i seconds] [-H] [-u]\n";
+      return 1;
+    }
+  }
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  struct stat sb;
+  if (fd < 0 || fstat(fd, &sb) != 0 || (size_t)sb.st_size < sizeof(TELEMETRY_REGION)){
+    std::cerr << "Error, no telemetry region " << name << "\n";
+    return 1;
+  }
+  const TELEMETRY_REGION * r = (const TELEMETRY_REGION*)mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (r == MAP_FAILED || memcmp(r->magic, TELEMETRY_MAGIC, 8) || r->version != TELEMETRY_VERSION ||
+      r->headerBytes != sizeof(TELEMETRY_REGION) || (size_t)sb.st_size < telemetryBytes(r->histograms)){
+    std::cerr << "Error, " << name << " is not a version " << TELEMETRY_VERSION << " telemetry region\n";
+    return 1;
+  }
+  if (histogram && !r->histograms){
+    std::cerr << "Error, the run publishes no histograms (-telemetry_hist 1)\n";
+    return 1;
+  }
+
+  TELEMETRY_REGION last, now;
+  std::vector<uint64_t> hist(histogram ? TELEMETRY_HISTOGRAM_WORDS : 0);
+  readRegion(r, last, histogram ? &hist[0] : NULL);
+  if (interval > 0){
+    std::cout << "    time s      MIPS  accesses/s    misses/s  miss %  transitions/s  entropy\n";
+    while (!last.finished){
+      usleep((useconds_t)(interval * 1e6));
+      readRegion(r, now, histogram ? &hist[0] : NULL);
+      if (now.updates != last.updates){
+	printRates(last, now);
+	last = now;
+      }
+      else if (kill((pid_t)now.pid, 0) != 0){
+	std::cout << "The tool exited without a final update\n";
+	break;
+      }
+    }
+    std::cout << "\n";
+  }
+  printStats(last);
+  if (histogram){
+    std::cout << "\nNumber of bytes with value:\n";
+    for (int i = 0; i < 256; ++i)
+      std::cout << i << ": " << hist[i] << "\n";
+  }
+
+  munmap((void*)r, sb.st_size);
+  if (unlink)
+    shm_unlink(name.c_str());
+  return 0;
+}